@@ -1,6 +1,10 @@
 #include "DataStructures.h"
 #include "Utils.h"
 #include <algorithm> // For max
+#include <thread>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // --- MOVIE HELPERS ---
 void Movie::addActor(string name) {
@@ -213,7 +217,7 @@ void MovieHash::search(string key) {
 }
 
 // --- GRAPH IMPLEMENTATION ---
-MovieGraph::MovieGraph(int n) : numMovies(n) {
+MovieGraph::MovieGraph(int n) : numMovies(n), oracle(nullptr), oracleLandmarks(0), oracleThreads(1) {
     adjList = new AdjListNode * [n];
     for (int i = 0; i < n; i++) adjList[i] = nullptr;
 }
@@ -228,6 +232,7 @@ MovieGraph::~MovieGraph() {
         }
     }
     delete[] adjList;
+    delete oracle;
 }
 
 void MovieGraph::addEdge(int src, int dest) {
@@ -238,6 +243,125 @@ void MovieGraph::addEdge(int src, int dest) {
     newNode = new AdjListNode(src);
     newNode->next = adjList[dest];
     adjList[dest] = newNode;
+
+    // Landmark distances and components are stale now; fall back to plain BFS
+    // until buildDistanceOracle is called again
+    delete oracle;
+    oracle = nullptr;
+}
+
+int* MovieGraph::computeDegrees() {
+    int* degree = new int[numMovies];
+    for (int i = 0; i < numMovies; i++) {
+        degree[i] = 0;
+        for (AdjListNode* temp = adjList[i]; temp; temp = temp->next) degree[i]++;
+    }
+    return degree;
+}
+
+// Reverse Cuthill-McKee: BFS from a low-degree node of each component,
+// visiting neighbors by increasing degree, then reverse the whole order.
+void MovieGraph::computeRCMOrder(int* newToOld) {
+    int* degree = computeDegrees();
+    bool* visited = new bool[numMovies];
+    for (int i = 0; i < numMovies; i++) visited[i] = false;
+
+    // Start candidates ordered by ascending degree (counting sort, stable)
+    int* byDegree = new int[numMovies];
+    int* bucket = new int[numMovies + 1];
+    for (int d = 0; d <= numMovies; d++) bucket[d] = 0;
+    for (int i = 0; i < numMovies; i++) bucket[degree[i]]++;
+    for (int d = 0, sum = 0; d <= numMovies; d++) { int c = bucket[d]; bucket[d] = sum; sum += c; }
+    for (int i = 0; i < numMovies; i++) byDegree[bucket[degree[i]]++] = i;
+
+    int* neighbors = new int[numMovies];
+    int count = 0;
+    for (int s = 0; s < numMovies; s++) {
+        int start = byDegree[s];
+        if (visited[start]) continue;
+
+        CustomQueue q;
+        visited[start] = true;
+        q.push(start);
+        while (!q.isEmpty()) {
+            int curr = q.pop();
+            newToOld[count++] = curr;
+
+            int n = 0;
+            for (AdjListNode* temp = adjList[curr]; temp; temp = temp->next) {
+                if (!visited[temp->dest]) { visited[temp->dest] = true; neighbors[n++] = temp->dest; }
+            }
+            // Insertion sort by degree (neighbor lists are short)
+            for (int i = 1; i < n; i++) {
+                int v = neighbors[i], j = i - 1;
+                while (j >= 0 && degree[neighbors[j]] > degree[v]) { neighbors[j + 1] = neighbors[j]; j--; }
+                neighbors[j + 1] = v;
+            }
+            for (int i = 0; i < n; i++) q.push(neighbors[i]);
+        }
+    }
+
+    for (int i = 0, j = numMovies - 1; i < j; i++, j--) {
+        int temp = newToOld[i]; newToOld[i] = newToOld[j]; newToOld[j] = temp;
+    }
+
+    delete[] neighbors;
+    delete[] bucket;
+    delete[] byDegree;
+    delete[] visited;
+    delete[] degree;
+}
+
+// Hubs first: descending degree, ties keep their original order
+void MovieGraph::computeDegreeOrder(int* newToOld) {
+    int* degree = computeDegrees();
+    int* bucket = new int[numMovies + 1];
+    for (int d = 0; d <= numMovies; d++) bucket[d] = 0;
+    for (int i = 0; i < numMovies; i++) bucket[numMovies - degree[i]]++;
+    for (int d = 0, sum = 0; d <= numMovies; d++) { int c = bucket[d]; bucket[d] = sum; sum += c; }
+    for (int i = 0; i < numMovies; i++) newToOld[bucket[numMovies - degree[i]]++] = i;
+    delete[] bucket;
+    delete[] degree;
+}
+
+// Rebuilds the adjacency lists under new IDs, allocated in new-ID order.
+// Each list keeps its original neighbor order so BFS results are unchanged.
+void MovieGraph::relabel(int* oldToNew) {
+    AdjListNode** newList = new AdjListNode * [numMovies];
+    int* newToOld = new int[numMovies];
+    for (int i = 0; i < numMovies; i++) newToOld[oldToNew[i]] = i;
+
+    int* neighbors = new int[numMovies];
+    for (int id = 0; id < numMovies; id++) {
+        int n = 0;
+        for (AdjListNode* temp = adjList[newToOld[id]]; temp; temp = temp->next) {
+            neighbors[n++] = oldToNew[temp->dest];
+        }
+
+        newList[id] = nullptr;
+        AdjListNode* tail = nullptr;
+        for (int i = 0; i < n; i++) {
+            AdjListNode* node = new AdjListNode(neighbors[i]);
+            if (tail) tail->next = node; else newList[id] = node;
+            tail = node;
+        }
+    }
+    delete[] neighbors;
+    delete[] newToOld;
+
+    for (int i = 0; i < numMovies; i++) {
+        AdjListNode* temp = adjList[i];
+        while (temp) {
+            AdjListNode* del = temp;
+            temp = temp->next;
+            delete del;
+        }
+    }
+    delete[] adjList;
+    adjList = newList;
+
+    // Landmark distances are indexed by node ID, rebuild under the new labels
+    if (oracle) buildDistanceOracle(oracleLandmarks, oracleThreads);
 }
 
 void MovieGraph::getRecommendations(int startId, Movie** movieDB) {
@@ -269,34 +393,49 @@ void MovieGraph::getRecommendations(int startId, Movie** movieDB) {
     delete[] visited;
 }
 
-void MovieGraph::getShortestPath(int startId, int endId, Movie** movieDB) {
-    int* parent = new int[numMovies];
-    bool* visited = new bool[numMovies];
-    for (int i = 0; i < numMovies; i++) { visited[i] = false; parent[i] = -1; }
+int MovieGraph::findPath(int startId, int endId, int* parent) {
+    if (parent) for (int i = 0; i < numMovies; i++) parent[i] = -1;
+    if (startId == endId) return 0;
+    if (oracle && !oracle->isReachable(startId, endId)) return -1; // Different components
+
+    // Landmark upper bound on the answer; nodes whose depth plus lower bound
+    // to the target exceeds it cannot be on a shortest path and are not expanded.
+    int bound = oracle ? oracle->upperBound(startId, endId) : -1;
+
+    int* depth = new int[numMovies];
+    for (int i = 0; i < numMovies; i++) depth[i] = -1;
 
     CustomQueue q;
-    visited[startId] = true;
+    depth[startId] = 0;
     q.push(startId);
-    bool found = false;
+    int result = -1;
 
-    while (!q.isEmpty()) {
+    while (!q.isEmpty() && result == -1) {
         int curr = q.pop();
-        if (curr == endId) { found = true; break; }
         AdjListNode* temp = adjList[curr];
         while (temp) {
-            if (!visited[temp->dest]) {
-                visited[temp->dest] = true;
-                parent[temp->dest] = curr;
-                q.push(temp->dest);
-            }
+            int next = temp->dest;
             temp = temp->next;
+            if (depth[next] != -1) continue;
+            depth[next] = depth[curr] + 1;
+            if (parent) parent[next] = curr;
+            if (next == endId) { result = depth[next]; break; }
+            if (bound >= 0 && depth[next] + oracle->lowerBound(next, endId) > bound) continue;
+            q.push(next);
         }
     }
+    delete[] depth;
+    return result;
+}
 
-    if (found) {
+void MovieGraph::getShortestPath(int startId, int endId, Movie** movieDB) {
+    int* parent = new int[numMovies];
+    int length = findPath(startId, endId, parent);
+
+    if (length >= 0) {
         cout << GREEN << "Shortest Path:" << RESET << endl;
-        // Backtrack (using a simple array to store path)
-        int path[100]; // Assuming path < 100
+        // Backtrack (path length is known, so size the array exactly)
+        int* path = new int[length + 1];
         int idx = 0;
         int curr = endId;
         while (curr != -1) {
@@ -308,10 +447,467 @@ void MovieGraph::getShortestPath(int startId, int endId, Movie** movieDB) {
             if (i > 0) cout << " -> ";
         }
         cout << endl;
+        delete[] path;
     }
     else {
         cout << RED << "No Connection Found." << RESET << endl;
     }
     delete[] parent;
-    delete[] visited;
+}
+
+void MovieGraph::buildDistanceOracle(int landmarks, int threads) {
+    oracleLandmarks = landmarks;
+    oracleThreads = threads;
+    delete oracle;
+    oracle = new DistanceOracle(adjList, numMovies, landmarks, threads);
+}
+
+bool MovieGraph::isReachable(int a, int b) {
+    if (oracle) return oracle->isReachable(a, b);
+    return findPath(a, b, nullptr) != -1;
+}
+
+// Landmark estimate in O(landmarks): an upper bound, exact when a landmark
+// lies on a shortest path. Never searches; use getShortestPath for exact answers.
+int MovieGraph::estimateDistance(int a, int b) {
+    if (a == b) return 0;
+    if (!oracle) return DIST_UNKNOWN;
+    if (!oracle->isReachable(a, b)) return DIST_UNREACHABLE;
+    int estimate = oracle->upperBound(a, b);
+    return estimate >= 0 ? estimate : DIST_UNKNOWN;
+}
+
+// --- DISTANCE ORACLE IMPLEMENTATION ---
+DistanceOracle::DistanceOracle(AdjListNode** adjList, int n, int maxLandmarks, int threads)
+    : numNodes(n), numLandmarks(0) {
+    componentId = new int[n];
+    int* componentSize = new int[n];
+    computeComponents(adjList, componentSize);
+
+    if (maxLandmarks < 0) maxLandmarks = 0;
+    landmarks = new int[maxLandmarks > 0 ? maxLandmarks : 1];
+    chooseLandmarks(adjList, componentSize, maxLandmarks);
+    delete[] componentSize;
+
+    // One BFS per landmark, landmark-major so each worker writes its own rows
+    unsigned char* byLandmark = new unsigned char[(long long)numLandmarks * n];
+    if (threads > numLandmarks) threads = numLandmarks;
+    if (threads <= 1) {
+        for (int l = 0; l < numLandmarks; l++) bfsFrom(adjList, landmarks[l], byLandmark + (long long)l * n);
+    }
+    else {
+        thread* workers = new thread[threads];
+        for (int t = 0; t < threads; t++) {
+            workers[t] = thread([=]() {
+                for (int l = t; l < numLandmarks; l += threads) {
+                    bfsFrom(adjList, landmarks[l], byLandmark + (long long)l * n);
+                }
+            });
+        }
+        for (int t = 0; t < threads; t++) workers[t].join();
+        delete[] workers;
+    }
+
+    // Transpose to node-major so a query reads two short contiguous vectors
+    dist = new unsigned char[(long long)n * numLandmarks];
+    for (int l = 0; l < numLandmarks; l++) {
+        for (int v = 0; v < n; v++) dist[(long long)v * numLandmarks + l] = byLandmark[(long long)l * n + v];
+    }
+    delete[] byLandmark;
+}
+
+DistanceOracle::~DistanceOracle() {
+    delete[] landmarks;
+    delete[] componentId;
+    delete[] dist;
+}
+
+void DistanceOracle::computeComponents(AdjListNode** adjList, int* componentSize) {
+    int* queue = new int[numNodes]; // Each node is enqueued once, a flat array is enough
+    for (int i = 0; i < numNodes; i++) { componentId[i] = -1; componentSize[i] = 0; }
+
+    int components = 0;
+    for (int s = 0; s < numNodes; s++) {
+        if (componentId[s] != -1) continue;
+        int head = 0, tail = 0;
+        componentId[s] = components;
+        queue[tail++] = s;
+        while (head < tail) {
+            int curr = queue[head++];
+            for (AdjListNode* temp = adjList[curr]; temp; temp = temp->next) {
+                if (componentId[temp->dest] == -1) {
+                    componentId[temp->dest] = components;
+                    queue[tail++] = temp->dest;
+                }
+            }
+        }
+        componentSize[components++] = tail;
+    }
+    delete[] queue;
+}
+
+// One landmark (its highest-degree node) per component, largest components
+// first. Leftover landmarks are spread evenly over the largest component.
+void DistanceOracle::chooseLandmarks(AdjListNode** adjList, int* componentSize, int maxLandmarks) {
+    int* hub = new int[numNodes];
+    int* hubDegree = new int[numNodes];
+    bool* taken = new bool[numNodes];
+    for (int i = 0; i < numNodes; i++) { hub[i] = -1; hubDegree[i] = -1; taken[i] = false; }
+
+    for (int v = 0; v < numNodes; v++) {
+        int degree = 0;
+        for (AdjListNode* temp = adjList[v]; temp; temp = temp->next) degree++;
+        int c = componentId[v];
+        if (degree > hubDegree[c]) { hubDegree[c] = degree; hub[c] = v; }
+    }
+
+    int largest = -1;
+    while (numLandmarks < maxLandmarks) {
+        int best = -1;
+        for (int c = 0; c < numNodes && componentSize[c] > 0; c++) {
+            if (!taken[c] && componentSize[c] > 1 && (best == -1 || componentSize[c] > componentSize[best])) best = c;
+        }
+        if (best == -1) break; // Singletons need no landmark
+        if (largest == -1) largest = best;
+        taken[best] = true;
+        landmarks[numLandmarks++] = hub[best];
+    }
+
+    int remaining = maxLandmarks - numLandmarks;
+    if (largest != -1 && remaining > 0) {
+        int size = componentSize[largest];
+        int member = 0, pick = 1;
+        for (int v = 0; v < numNodes && pick <= remaining; v++) {
+            if (componentId[v] != largest) continue;
+            if (member == (long long)pick * size / (remaining + 1)) {
+                if (v != hub[largest]) landmarks[numLandmarks++] = v;
+                pick++;
+            }
+            member++;
+        }
+    }
+
+    delete[] taken;
+    delete[] hubDegree;
+    delete[] hub;
+}
+
+void DistanceOracle::bfsFrom(AdjListNode** adjList, int source, unsigned char* out) {
+    int* queue = new int[numNodes];
+    for (int i = 0; i < numNodes; i++) out[i] = ORACLE_FAR;
+
+    int head = 0, tail = 0;
+    out[source] = 0;
+    queue[tail++] = source;
+    while (head < tail) {
+        int curr = queue[head++];
+        if (out[curr] + 1 >= ORACLE_FAR) continue; // Saturated, leave the rest as far
+        for (AdjListNode* temp = adjList[curr]; temp; temp = temp->next) {
+            if (out[temp->dest] == ORACLE_FAR) {
+                out[temp->dest] = out[curr] + 1;
+                queue[tail++] = temp->dest;
+            }
+        }
+    }
+    delete[] queue;
+}
+
+int DistanceOracle::getLandmarkCount() { return numLandmarks; }
+
+bool DistanceOracle::isReachable(int a, int b) { return componentId[a] == componentId[b]; }
+
+int DistanceOracle::lowerBound(int a, int b) {
+    const unsigned char* da = dist + (long long)a * numLandmarks;
+    const unsigned char* db = dist + (long long)b * numLandmarks;
+    int best = 0;
+    for (int l = 0; l < numLandmarks; l++) {
+        if (da[l] == ORACLE_FAR || db[l] == ORACLE_FAR) continue;
+        int diff = da[l] > db[l] ? da[l] - db[l] : db[l] - da[l];
+        if (diff > best) best = diff;
+    }
+    return best;
+}
+
+int DistanceOracle::upperBound(int a, int b) {
+    if (a == b) return 0;
+    if (!isReachable(a, b)) return -1;
+    const unsigned char* da = dist + (long long)a * numLandmarks;
+    const unsigned char* db = dist + (long long)b * numLandmarks;
+    int best = -1;
+    for (int l = 0; l < numLandmarks; l++) {
+        if (da[l] == ORACLE_FAR || db[l] == ORACLE_FAR) continue;
+        int sum = da[l] + db[l];
+        if (best == -1 || sum < best) best = sum;
+    }
+    return best;
+}
+
+// --- KNN IMPLEMENTATION ---
+// Similarity = 0.5 * genre Jaccard + 0.3 * shared actors / 3
+//            + 0.1 * year closeness + 0.1 * rating closeness
+const float KNN_W_GENRE = 0.5f;
+const float KNN_W_ACTOR = 0.1f; // Per shared actor (max 3)
+const float KNN_W_YEAR = 0.1f;
+const float KNN_W_RATING = 0.1f;
+
+MovieKNN::MovieKNN(Movie** movieDB, int n, int* originalId) : numMovies(n), numThreads(1), genreCount(0) {
+    paddedSize = (n + KNN_LANES - 1) / KNN_LANES * KNN_LANES;
+    genreMask = new unsigned int[paddedSize];
+    actorA = new unsigned int[paddedSize];
+    actorB = new unsigned int[paddedSize];
+    actorC = new unsigned int[paddedSize];
+    yearNorm = new float[paddedSize];
+    ratingNorm = new float[paddedSize];
+    titleHash = new unsigned int[n];
+    tieKey = new int[n];
+    movies = movieDB;
+    for (int i = 0; i < n; i++) tieKey[i] = originalId ? originalId[i] : i;
+
+    int minYear = 0, maxYear = 0;
+    for (int i = 0; i < n; i++) {
+        int y = movieDB[i]->year;
+        if (y == 0) continue;
+        if (minYear == 0 || y < minYear) minYear = y;
+        if (y > maxYear) maxYear = y;
+    }
+    float yearSpan = (maxYear > minYear) ? (float)(maxYear - minYear) : 1.0f;
+
+    for (int i = 0; i < paddedSize; i++) {
+        genreMask[i] = 0; actorA[i] = 0; actorB[i] = 0; actorC[i] = 0;
+        yearNorm[i] = 0.0f; ratingNorm[i] = 0.0f;
+        if (i >= n) continue; // Padding rows never match anything
+
+        Movie* m = movieDB[i];
+        StringNode* curr = m->genres;
+        while (curr) { genreMask[i] |= genreBit(curr->value); curr = curr->next; }
+
+        unsigned int* slots[3] = { actorA, actorB, actorC };
+        int slot = 0;
+        curr = m->actors;
+        while (curr && slot < 3) { slots[slot++][i] = actorHash(curr->value); curr = curr->next; }
+
+        // Missing years sit in the middle so they neither help nor hurt much
+        yearNorm[i] = (m->year == 0) ? 0.5f : (m->year - minYear) / yearSpan;
+        ratingNorm[i] = (float)(m->rating / 10.0);
+        titleHash[i] = actorHash(m->title);
+    }
+}
+
+MovieKNN::~MovieKNN() {
+    delete[] genreMask;
+    delete[] actorA;
+    delete[] actorB;
+    delete[] actorC;
+    delete[] yearNorm;
+    delete[] ratingNorm;
+    delete[] titleHash;
+    delete[] tieKey;
+}
+
+void MovieKNN::setThreads(int t) { numThreads = t < 1 ? 1 : t; }
+int MovieKNN::getThreads() { return numThreads; }
+
+unsigned int MovieKNN::genreBit(string genre) {
+    for (int i = 0; i < genreCount; i++) {
+        if (genreNames[i] == genre) return 1u << i;
+    }
+    if (genreCount == KNN_MAX_GENRES) return 0; // Out of bits, ignore rare genres
+    genreNames[genreCount] = genre;
+    return 1u << genreCount++;
+}
+
+unsigned int MovieKNN::actorHash(string name) {
+    unsigned int hash = 5381;
+    for (char c : name) hash = ((hash << 5) + hash) + c;
+    return hash ? hash : 1; // 0 is reserved for "no actor"
+}
+
+static inline int popCount(unsigned int x) {
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    x = x + (x >> 8);
+    x = x + (x >> 16);
+    return x & 0x3F;
+}
+
+#ifdef __SSE2__
+static inline __m128i popCount4(__m128i x) {
+    x = _mm_sub_epi32(x, _mm_and_si128(_mm_srli_epi32(x, 1), _mm_set1_epi32(0x55555555)));
+    x = _mm_add_epi32(_mm_and_si128(x, _mm_set1_epi32(0x33333333)),
+                      _mm_and_si128(_mm_srli_epi32(x, 2), _mm_set1_epi32(0x33333333)));
+    x = _mm_and_si128(_mm_add_epi32(x, _mm_srli_epi32(x, 4)), _mm_set1_epi32(0x0F0F0F0F));
+    x = _mm_add_epi32(x, _mm_srli_epi32(x, 8));
+    x = _mm_add_epi32(x, _mm_srli_epi32(x, 16));
+    return _mm_and_si128(x, _mm_set1_epi32(0x3F));
+}
+#endif
+
+// Scores rows [begin, end); begin and end must be multiples of KNN_LANES
+void MovieKNN::scoreRange(int queryId, int begin, int end, float* scores) {
+    unsigned int qMask = genreMask[queryId];
+    unsigned int qActors[3] = { actorA[queryId], actorB[queryId], actorC[queryId] };
+    float qYear = yearNorm[queryId];
+    float qRating = ratingNorm[queryId];
+
+#ifdef __SSE2__
+    const __m128i vMask = _mm_set1_epi32((int)qMask);
+    const __m128 vYear = _mm_set1_ps(qYear);
+    const __m128 vRating = _mm_set1_ps(qRating);
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 wGenre = _mm_set1_ps(KNN_W_GENRE);
+    const __m128 wActor = _mm_set1_ps(KNN_W_ACTOR);
+    const __m128 wYear = _mm_set1_ps(KNN_W_YEAR);
+    const __m128 wRating = _mm_set1_ps(KNN_W_RATING);
+
+    for (int i = begin; i < end; i += KNN_LANES) {
+        // Genre Jaccard: |a & b| / max(|a | b|, 1)
+        __m128i mask = _mm_loadu_si128((const __m128i*)(genreMask + i));
+        __m128 inter = _mm_cvtepi32_ps(popCount4(_mm_and_si128(mask, vMask)));
+        __m128 uni = _mm_max_ps(_mm_cvtepi32_ps(popCount4(_mm_or_si128(mask, vMask))), vOne);
+        __m128 score = _mm_mul_ps(wGenre, _mm_div_ps(inter, uni));
+
+        // Shared actors: compare each query actor against all three slots
+        __m128i a = _mm_loadu_si128((const __m128i*)(actorA + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(actorB + i));
+        __m128i c = _mm_loadu_si128((const __m128i*)(actorC + i));
+        __m128i shared = _mm_setzero_si128();
+        for (int q = 0; q < 3; q++) {
+            if (qActors[q] == 0) continue;
+            __m128i qa = _mm_set1_epi32((int)qActors[q]);
+            __m128i hit = _mm_or_si128(_mm_cmpeq_epi32(a, qa),
+                          _mm_or_si128(_mm_cmpeq_epi32(b, qa), _mm_cmpeq_epi32(c, qa)));
+            shared = _mm_sub_epi32(shared, hit); // hit lanes are -1
+        }
+        score = _mm_add_ps(score, _mm_mul_ps(wActor, _mm_cvtepi32_ps(shared)));
+
+        // Year and rating closeness: 1 - |x - q|
+        __m128 dy = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(yearNorm + i), vYear), vAbs);
+        __m128 dr = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(ratingNorm + i), vRating), vAbs);
+        score = _mm_add_ps(score, _mm_mul_ps(wYear, _mm_sub_ps(vOne, dy)));
+        score = _mm_add_ps(score, _mm_mul_ps(wRating, _mm_sub_ps(vOne, dr)));
+
+        _mm_storeu_ps(scores + i, score);
+    }
+#else
+    for (int i = begin; i < end; i++) {
+        int inter = popCount(genreMask[i] & qMask);
+        int uni = popCount(genreMask[i] | qMask);
+        float score = KNN_W_GENRE * inter / (float)(uni > 1 ? uni : 1);
+
+        int shared = 0;
+        for (int q = 0; q < 3; q++) {
+            if (qActors[q] == 0) continue;
+            if (actorA[i] == qActors[q] || actorB[i] == qActors[q] || actorC[i] == qActors[q]) shared++;
+        }
+        score += KNN_W_ACTOR * shared;
+
+        float dy = yearNorm[i] - qYear;
+        float dr = ratingNorm[i] - qRating;
+        score += KNN_W_YEAR * (1.0f - (dy < 0 ? -dy : dy));
+        score += KNN_W_RATING * (1.0f - (dr < 0 ? -dr : dr));
+        scores[i] = score;
+    }
+#endif
+}
+
+// Higher score first; equal scores go to the lower original ID
+bool MovieKNN::ranksBefore(float scoreA, int idA, float scoreB, int idB) {
+    if (scoreA != scoreB) return scoreA > scoreB;
+    return tieKey[idA] < tieKey[idB];
+}
+
+// Keeps the k best rows of [begin, end) in descending score order, returns how many were found
+int MovieKNN::selectTopK(int queryId, int begin, int end, float* scores, int k, int* outIds, float* outScores) {
+    int found = 0;
+    if (end > numMovies) end = numMovies; // Skip padding rows
+    for (int i = begin; i < end; i++) {
+        if (i == queryId) continue;
+        // The catalog repeats some titles; a copy of the query is not a recommendation
+        if (titleHash[i] == titleHash[queryId] && movies[i]->title == movies[queryId]->title) continue;
+        float s = scores[i];
+        if (found == k && !ranksBefore(s, i, outScores[k - 1], outIds[k - 1])) continue;
+
+        // Insertion into the sorted result arrays
+        int pos = (found < k) ? found++ : k - 1;
+        while (pos > 0 && ranksBefore(s, i, outScores[pos - 1], outIds[pos - 1])) {
+            outScores[pos] = outScores[pos - 1];
+            outIds[pos] = outIds[pos - 1];
+            pos--;
+        }
+        outScores[pos] = s;
+        outIds[pos] = i;
+    }
+    return found;
+}
+
+int MovieKNN::findSimilar(int queryId, int k, int* outIds, float* outScores) {
+    if (queryId < 0 || queryId >= numMovies || k <= 0) return 0;
+    float* scores = new float[paddedSize];
+
+    // Only split when every worker gets enough rows to pay for its startup
+    int threads = numThreads;
+    int maxThreads = paddedSize / KNN_MIN_ROWS_PER_THREAD;
+    if (threads > maxThreads) threads = maxThreads > 0 ? maxThreads : 1;
+    int blocks = paddedSize / KNN_LANES;
+
+    int found = 0;
+    if (threads == 1) {
+        scoreRange(queryId, 0, paddedSize, scores);
+        found = selectTopK(queryId, 0, paddedSize, scores, k, outIds, outScores);
+    }
+    else {
+        // Each worker scores and ranks its own slice, then the partial lists are merged
+        int* localIds = new int[threads * k];
+        float* localScores = new float[threads * k];
+        int* localFound = new int[threads];
+        thread* workers = new thread[threads];
+
+        for (int t = 0; t < threads; t++) {
+            int begin = (int)((long long)blocks * t / threads) * KNN_LANES;
+            int end = (int)((long long)blocks * (t + 1) / threads) * KNN_LANES;
+            workers[t] = thread([=]() {
+                scoreRange(queryId, begin, end, scores);
+                localFound[t] = selectTopK(queryId, begin, end, scores, k, localIds + t * k, localScores + t * k);
+            });
+        }
+        for (int t = 0; t < threads; t++) workers[t].join();
+
+        for (int t = 0; t < threads; t++) {
+            for (int j = 0; j < localFound[t]; j++) {
+                float s = localScores[t * k + j];
+                int id = localIds[t * k + j];
+                if (found == k && !ranksBefore(s, id, outScores[k - 1], outIds[k - 1])) break; // Rest of this list is worse
+                int pos = (found < k) ? found++ : k - 1;
+                while (pos > 0 && ranksBefore(s, id, outScores[pos - 1], outIds[pos - 1])) {
+                    outScores[pos] = outScores[pos - 1];
+                    outIds[pos] = outIds[pos - 1];
+                    pos--;
+                }
+                outScores[pos] = s;
+                outIds[pos] = id;
+            }
+        }
+
+        delete[] workers;
+        delete[] localFound;
+        delete[] localScores;
+        delete[] localIds;
+    }
+
+    delete[] scores;
+    return found;
+}
+
+void MovieKNN::getRecommendations(int startId, Movie** movieDB) {
+    int ids[10];
+    float scores[10];
+    int found = findSimilar(startId, 10, ids, scores);
+
+    cout << CYAN << "Similar Recommendations (kNN):" << RESET << endl;
+    for (int i = 0; i < found; i++) {
+        cout << i + 1 << ". " << movieDB[ids[i]]->title
+             << " (" << (int)(scores[i] * 100 + 0.5f) << "% match)" << endl;
+    }
 }
\ No newline at end of file
@@ -6,6 +6,12 @@
 using namespace std;
 
 const int TABLE_SIZE = 10007;
+const int KNN_MAX_GENRES = 32;  // One bit per genre in the feature mask
+const int KNN_LANES = 4;        // Floats per SIMD register (SSE)
+const int KNN_MIN_ROWS_PER_THREAD = 65536; // Smaller slices cost more to spawn than to scan
+const unsigned char ORACLE_FAR = 255; // Landmark not reached (or > 254 hops away)
+const int DIST_UNREACHABLE = -1;      // estimateDistance: different components
+const int DIST_UNKNOWN = -2;          // estimateDistance: no landmark covers the pair
 
 // --- CUSTOM NODES ---
 
@@ -23,6 +29,14 @@ struct IntNode {
     IntNode(int v) : value(v), next(nullptr) {}
 };
 
+// --- ENGINE OPTIONS ---
+
+// Which engine answers a recommendation query
+enum RecommendEngine { ENGINE_GRAPH, ENGINE_KNN };
+
+// Node relabeling strategies applied after the graph is built
+enum ReorderMode { REORDER_NONE, REORDER_RCM, REORDER_DEGREE, REORDER_GENRE };
+
 // --- DATA STRUCTURE CLASSES ---
 
 // Custom Queue class for BFS
@@ -92,16 +106,88 @@ public:
     void search(string key);
 };
 
+// Landmark Distance Oracle
+// BFS distances from a few landmark nodes, stored node-major so one node's
+// vector is contiguous. Triangle inequality gives lower/upper bounds on any
+// pair in O(landmarks); component IDs answer reachability in O(1).
+// Pairs more than 254 hops from every shared landmark have no estimate.
+class DistanceOracle {
+private:
+    int numNodes;
+    int numLandmarks;
+    int* landmarks;
+    int* componentId;
+    unsigned char* dist;        // dist[node * numLandmarks + l]
+
+    void computeComponents(AdjListNode** adjList, int* componentSize);
+    void chooseLandmarks(AdjListNode** adjList, int* componentSize, int maxLandmarks);
+    void bfsFrom(AdjListNode** adjList, int source, unsigned char* out);
+
+public:
+    DistanceOracle(AdjListNode** adjList, int n, int maxLandmarks, int threads);
+    ~DistanceOracle();
+    int getLandmarkCount();
+    bool isReachable(int a, int b);
+    int lowerBound(int a, int b);
+    int upperBound(int a, int b);   // -1 if unreachable or no landmark covers both
+};
+
 // Graph Class
 class MovieGraph {
 private:
     AdjListNode** adjList;
     int numMovies;
+    DistanceOracle* oracle;
+    int oracleLandmarks;
+    int oracleThreads;
+    int* computeDegrees();
+    int findPath(int startId, int endId, int* parent);
 
 public:
     MovieGraph(int n);
     ~MovieGraph();
     void addEdge(int src, int dest);
+    void computeRCMOrder(int* newToOld);
+    void computeDegreeOrder(int* newToOld);
+    void relabel(int* oldToNew);
+    void buildDistanceOracle(int landmarks, int threads);
+    bool isReachable(int a, int b);
+    int estimateDistance(int a, int b);
     void getRecommendations(int startId, Movie** movieDB);
     void getShortestPath(int startId, int endId, Movie** movieDB);
+};
+
+// Feature-Vector kNN Class
+// Each movie is encoded as a fixed-size feature vector and stored as
+// structure-of-arrays so the scoring kernel can process KNN_LANES movies per step.
+class MovieKNN {
+private:
+    int numMovies;
+    int paddedSize;             // numMovies rounded up to a multiple of KNN_LANES
+    int numThreads;
+    unsigned int* genreMask;    // Bit i set => movie has genreNames[i]
+    unsigned int* actorA;       // Hashes of the top 3 billed actors (0 = none)
+    unsigned int* actorB;
+    unsigned int* actorC;
+    float* yearNorm;            // Release year scaled to [0, 1]
+    float* ratingNorm;          // Rating scaled to [0, 1]
+    unsigned int* titleHash;    // Used to skip re-releases of the query title
+    Movie** movies;             // Caller's movieDB, for exact title checks
+    int* tieKey;                // Stable ID for breaking equal scores (survives reordering)
+    string genreNames[KNN_MAX_GENRES];
+    int genreCount;
+
+    unsigned int genreBit(string genre);
+    unsigned int actorHash(string name);
+    void scoreRange(int queryId, int begin, int end, float* scores);
+    bool ranksBefore(float scoreA, int idA, float scoreB, int idB);
+    int selectTopK(int queryId, int begin, int end, float* scores, int k, int* outIds, float* outScores);
+
+public:
+    MovieKNN(Movie** movieDB, int n, int* originalId = nullptr);
+    ~MovieKNN();
+    void setThreads(int t);
+    int getThreads();
+    int findSimilar(int queryId, int k, int* outIds, float* outScores);
+    void getRecommendations(int startId, Movie** movieDB);
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <thread>
 #include "DataStructures.h"
 #include "Utils.h"
 
@@ -7,6 +8,7 @@ using namespace std;
 using namespace Utils;
 
 const int MAX_MOVIES = 5000;
+const int ORACLE_LANDMARKS = 16;
 
 class SystemManager {
 public:
@@ -14,11 +16,14 @@ public:
     MovieHash actorIndex;
     MovieHash genreIndex;
     MovieGraph* graph;
+    MovieKNN* knn;
     Movie* movieDB[MAX_MOVIES];
+    int originalId[MAX_MOVIES]; // Current ID -> CSV row ID
+    int currentId[MAX_MOVIES];  // CSV row ID -> current ID
     int movieCount;
 
-    SystemManager() : graph(nullptr), movieCount(0) {
-        for (int i = 0; i < MAX_MOVIES; i++) movieDB[i] = nullptr;
+    SystemManager() : graph(nullptr), knn(nullptr), movieCount(0) {
+        for (int i = 0; i < MAX_MOVIES; i++) { movieDB[i] = nullptr; originalId[i] = i; currentId[i] = i; }
     }
 
     // Helper to parse CSV fields manually
@@ -40,7 +45,73 @@ public:
         return result;
     }
 
-    void loadData(string filename) {
+    // Groups movies by the first genre in their CSV row (stable counting sort)
+    void computeGenreOrder(int* newToOld) {
+        string bucketNames[64];
+        int bucketCount = 0;
+        int* bucketOf = new int[movieCount];
+        int bucketSize[65] = { 0 };
+
+        for (int i = 0; i < movieCount; i++) {
+            // addGenre prepends, so the first CSV genre is at the tail of the list
+            StringNode* first = movieDB[i]->genres;
+            while (first && first->next) first = first->next;
+            string key = first ? first->value : "";
+            int b = 0;
+            while (b < bucketCount && bucketNames[b] != key) b++;
+            if (b == bucketCount) {
+                if (bucketCount < 64) bucketNames[bucketCount++] = key;
+                else b = 64; // Overflow bucket for rare genres
+            }
+            bucketOf[i] = b;
+            bucketSize[b]++;
+        }
+        for (int b = 0, sum = 0; b <= 64; b++) { int c = bucketSize[b]; bucketSize[b] = sum; sum += c; }
+        for (int i = 0; i < movieCount; i++) newToOld[bucketSize[bucketOf[i]]++] = i;
+        delete[] bucketOf;
+    }
+
+    // Relabels movie IDs so graph neighbors sit close together in memory.
+    // Updates movieDB, Movie::id, the graph and the kNN index; the AVL tree
+    // and hash tables store Movie pointers and need no changes.
+    void reorderMovies(ReorderMode mode) {
+        if (mode == REORDER_NONE || !graph) return;
+        int* newToOld = new int[movieCount];
+        if (mode == REORDER_RCM) graph->computeRCMOrder(newToOld);
+        else if (mode == REORDER_DEGREE) graph->computeDegreeOrder(newToOld);
+        else computeGenreOrder(newToOld);
+
+        int* oldToNew = new int[movieCount];
+        Movie** oldDB = new Movie * [movieCount];
+        int* oldOriginal = new int[movieCount];
+        for (int i = 0; i < movieCount; i++) {
+            oldToNew[newToOld[i]] = i;
+            oldDB[i] = movieDB[i];
+            oldOriginal[i] = originalId[i];
+        }
+
+        graph->relabel(oldToNew);
+        for (int i = 0; i < movieCount; i++) {
+            movieDB[i] = oldDB[newToOld[i]];
+            movieDB[i]->id = i;
+            originalId[i] = oldOriginal[newToOld[i]];
+            currentId[originalId[i]] = i;
+        }
+
+        if (knn) {
+            int threads = knn->getThreads();
+            delete knn;
+            knn = new MovieKNN(movieDB, movieCount, originalId);
+            knn->setThreads(threads);
+        }
+
+        delete[] oldOriginal;
+        delete[] oldDB;
+        delete[] oldToNew;
+        delete[] newToOld;
+    }
+
+    void loadData(string filename, ReorderMode mode = REORDER_NONE) {
         cout << YELLOW << "[*] Loading Database from " << filename << "..." << RESET << endl;
         ifstream file(filename);
         if (!file.is_open()) { cout << RED << "Error: File not found!" << RESET << endl; return; }
@@ -121,9 +192,29 @@ public:
                 }
             }
         }
+
+        if (mode != REORDER_NONE) {
+            cout << YELLOW << "[*] Reordering Graph for Locality..." << RESET << endl;
+            reorderMovies(mode);
+        }
+
+        cout << YELLOW << "[*] Precomputing Landmark Distances..." << RESET << endl;
+        graph->buildDistanceOracle(ORACLE_LANDMARKS, (int)thread::hardware_concurrency());
+
+        // Feature vectors for the kNN engine
+        cout << YELLOW << "[*] Building Feature Index..." << RESET << endl;
+        knn = new MovieKNN(movieDB, movieCount, originalId);
         cout << GREEN << "[+] System Ready!" << RESET << endl;
     }
 
+    // Same query, either engine, so latency and quality can be compared
+    void recommend(Movie* m, RecommendEngine engine) {
+        Timer t;
+        if (engine == ENGINE_KNN) knn->getRecommendations(m->id, movieDB);
+        else graph->getRecommendations(m->id, movieDB);
+        t.printDuration();
+    }
+
     void printMovie(Movie* m) {
         cout << "\n" << BOLD << "==============================" << RESET << endl;
         cout << CYAN << " TITLE : " << RESET << m->title << endl;
@@ -160,8 +251,9 @@ public:
             }
             else if (choice == 3) {
                 cout << "Enter Title: "; getline(cin, input);
+                cout << "Engine (1. Graph, 2. kNN): "; getline(cin, input2);
                 Movie* m = avl.search(cleanString(input));
-                if (m) graph->getRecommendations(m->id, movieDB);
+                if (m) recommend(m, input2 == "2" ? ENGINE_KNN : ENGINE_GRAPH);
                 else cout << RED << "Movie not found." << RESET << endl;
             }
             else if (choice == 4) {